@@ -79,7 +79,78 @@ enum RDWR_WIDTH {
     WIDTH_DWORD = 2 * WIDTH_WORD,
 };
 
-static const char *short_options = "f:o:w:t:s:n:ci:m:P:b:?hd:v";
+union elem_value {
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+    uint8_t bytes[WIDTH_DWORD];
+};
+
+enum ACCESS_STRATEGY {
+    ACCESS_AUTO,
+    ACCESS_FULL_MAP,
+    ACCESS_SPARSE_MAP,
+    ACCESS_PIO,
+    ACCESS_NUM,
+};
+
+enum DUMP_FORMAT {
+    FORMAT_TEXT,
+    FORMAT_JSONL,
+    FORMAT_CSV,
+    FORMAT_BIN,
+    FORMAT_NUM,
+};
+
+/*
+ * Auto select sparse mapping if one stride spans at least this many pages.
+ * If every element stays inside one page, at least one page between elements
+ * is never mapped and under AUTO every element gets a run of its own. An
+ * element crossing a page boundary (unaligned offset) may reach the page just
+ * before the next element's page, and then their runs coalesce.
+ */
+#define SPARSE_STRIDE_PAGES_MIN     2
+/*
+ * Sparse mapping maps at most this many runs at a time, and moves the window
+ * along as elements are accessed. It bounds the mmap() calls per window and
+ * stays well below the default vm.max_map_count (65530), which also counts
+ * the mappings the process already has.
+ */
+#define SPARSE_MAP_RUNS_MAX         1024
+
+/* One mmap()ed run of file pages covering elements [first, next run's first). */
+struct map_run {
+    unsigned long long first;
+    /* File offset of the mapping, page aligned. */
+    unsigned long long pos;
+    size_t len;
+    void *base;
+};
+
+struct mem_access {
+    enum ACCESS_STRATEGY strategy;
+    const char *file;
+    int fd;
+    int prot;
+    unsigned long long page_size;
+    unsigned long long offset;
+    enum RDWR_WIDTH width;
+    size_t step;
+    size_t index;
+    unsigned long long number;
+    /* No runs for ACCESS_PIO, one for ACCESS_FULL_MAP. */
+    struct map_run *runs;
+    size_t nr_runs;
+    size_t runs_max;
+    /* Elements [win_first, win_end) are covered by the mapped runs. */
+    unsigned long long win_first;
+    unsigned long long win_end;
+    /* Lookup cursor, accesses are mostly sequential. */
+    size_t last_run;
+};
+
+static const char *short_options = "f:o:w:t:s:n:ci:m:a:F:P:b:?hd:v";
 static const struct option long_options[] = {
     {"file",                    required_argument,  NULL,   'f'},
     {"offset",                  required_argument,  NULL,   'o'},
@@ -90,6 +161,8 @@ static const struct option long_options[] = {
     {"char",                    no_argument,        NULL,   'c'},
     {"index",                   required_argument,  NULL,   'i'},
     {"mode",                    required_argument,  NULL,   'm'},
+    {"access",                  required_argument,  NULL,   'a'},
+    {"format",                  required_argument,  NULL,   'F'},
     {"print-count-one-line",    required_argument,  NULL,   'P'},
     {"bin-file",                required_argument,  NULL,   'b'},
     {"help",                    no_argument,        NULL,   'h'},
@@ -112,7 +185,9 @@ static __attribute__((noreturn)) void usage(const char *prog, FILE *fp, int _exi
                 prog);
     fprintf(fp, "%*.*s  [-c,--char]"
                       " [-i,--index index]"
-                      " [-m,--mode mode]\n",
+                      " [-m,--mode mode]"
+                      " [-a,--access access]"
+                      " [-F,--format format]\n",
                 len_prog, len_prog, "");
     fprintf(fp, "%*.*s  [-P,--print-count-one-line print_cnt_one_line]\n",
                 len_prog, len_prog, "");
@@ -151,6 +226,15 @@ static __attribute__((noreturn)) void usage(const char *prog, FILE *fp, int _exi
                                                             "WR_RD or RD_WR_RD).\n"
                 "                          Default %d (RD_ONLY).\n", MODE_NUM - 1,
                                                                      MODE_RD_ONLY);
+    fprintf(fp, "  -a,--access     access: Access strategy.\n"
+                "                          Optional: 0 - %d (AUTO, FULL_MAP, SPARSE_MAP "
+                                                            "or PIO).\n"
+                "                          Default %d (AUTO).\n", ACCESS_NUM - 1,
+                                                                  ACCESS_AUTO);
+    fprintf(fp, "  -F,--format     format: Dump format.\n"
+                "                          Optional: 0 - %d (TEXT, JSONL, CSV or BIN).\n"
+                "                          Default %d (TEXT).\n", FORMAT_NUM - 1,
+                                                                  FORMAT_TEXT);
     fprintf(fp, "  -P,--print-count-one-line\n"
                 "      print_cnt_one_line: Number of data element printed in one line.\n"
                 "                          Default auto.\n");
@@ -180,6 +264,26 @@ static __attribute__((noreturn)) void usage(const char *prog, FILE *fp, int _exi
                      "(ONLY ONE) must be specified.\n", ++i);
     fprintf(fp, "%3d. The size of [bin_file] MUST be equal to [number * width].\n", ++i);
     fprintf(fp, "%3d. The length of [data] sequence MUST be equal to [number].\n", ++i);
+    fprintf(fp, "%3d. AUTO access maps only the pages holding the selected elements "
+                     "(SPARSE_MAP)\n"
+                "     if one stride spans at least %d pages, otherwise the whole span "
+                     "(FULL_MAP).\n"
+                "     SPARSE_MAP maps at most %d runs of pages at a time. "
+                     "pread/pwrite (PIO)\n"
+                "     is only used if selected, it may not reach MMIO or keep the "
+                     "access width.\n", ++i, SPARSE_STRIDE_PAGES_MIN, SPARSE_MAP_RUNS_MAX);
+    fprintf(fp, "%3d. JSONL, CSV and BIN dump one record (offset, width, value, pass) "
+                     "per element,\n"
+                "     where offset is in bytes from [offset] as in TEXT, and pass is "
+                     "2 for the\n"
+                "     read after write in RD_WR_RD, otherwise 1. "
+                     "JSONL and CSV are in decimal,\n"
+                "     except the JSONL value, a hex string such as \"0x00ff\", "
+                     "as doubles in JSON\n"
+                "     parsers cannot hold all 64-bit values.\n"
+                "     A BIN record is 4 big-endian 64-bit integers. "
+                     "[-c,--char] and\n"
+                "     [-P,--print-count-one-line] are ignored.\n", ++i);
 
     exit(_exit);
 }
@@ -200,39 +304,334 @@ static int count_valid_bit(unsigned long long n)
     return count;
 }
 
+static inline unsigned long long elem_pos(const struct mem_access *acc,
+                                          unsigned long long i)
+{
+    return acc->offset + (i * acc->step + acc->index) * acc->width;
+}
+
+/*
+ * Walk the selected elements from first and coalesce the pages they touch
+ * into at most runs_max runs. Return the number of runs and set the window.
+ */
+static size_t access_build_runs(struct mem_access *acc,
+                                const unsigned long long first)
+{
+    const unsigned long long page_size = acc->page_size;
+    struct map_run *runs = acc->runs;
+    unsigned long long i;
+    unsigned long long pos;
+    unsigned long long page_lo, page_hi;
+    unsigned long long run_hi = 0;
+    size_t nr_runs = 0;
+
+    for (i = first; i < acc->number; i++) {
+        pos = elem_pos(acc, i);
+        page_lo = pos / page_size;
+        page_hi = (pos + acc->width - 1) / page_size;
+
+        if (nr_runs && page_lo <= run_hi + 1) {
+            if (page_hi > run_hi)
+                run_hi = page_hi;
+        } else {
+            if (nr_runs == acc->runs_max)
+                break;
+            nr_runs++;
+            run_hi = page_hi;
+            runs[nr_runs - 1].first = i;
+            runs[nr_runs - 1].pos = page_lo * page_size;
+        }
+        runs[nr_runs - 1].len = (run_hi + 1) * page_size - runs[nr_runs - 1].pos;
+    }
+
+    acc->win_first = first;
+    acc->win_end = i;
+
+    return nr_runs;
+}
+
+static void access_unmap(struct mem_access *acc)
+{
+    size_t r;
+
+    for (r = 0; r < acc->nr_runs; r++) {
+        if (acc->runs[r].base)
+            munmap(acc->runs[r].base, acc->runs[r].len);
+        acc->runs[r].base = NULL;
+    }
+    acc->nr_runs = 0;
+    acc->win_first = acc->win_end = 0;
+    acc->last_run = 0;
+}
+
+static int access_map(struct mem_access *acc)
+{
+    size_t r;
+
+    for (r = 0; r < acc->nr_runs; r++) {
+        struct map_run *run = &acc->runs[r];
+
+        run->base = mmap(NULL, run->len, acc->prot, MAP_SHARED, acc->fd, run->pos);
+        if (run->base == MAP_FAILED) {
+            fprintf(STDERR, "%s: mmap %s offset 0x%llx, size 0x%llx\n", strerror(errno),
+                                 acc->file, run->pos, (unsigned long long)run->len);
+            run->base = NULL;
+            access_unmap(acc);
+            return -1;
+        }
+        LOG_DEBUG("run %llu: element %llu, offset 0x%llx, size 0x%llx\n",
+                  (unsigned long long)r, run->first, run->pos,
+                  (unsigned long long)run->len);
+    }
+
+    return 0;
+}
+
+/* Replace the mapped sparse runs by the window starting at element first. */
+static int access_map_window(struct mem_access *acc, const unsigned long long first)
+{
+    access_unmap(acc);
+    acc->nr_runs = access_build_runs(acc, first);
+    LOG_DEBUG("window: element %llu - %llu, %llu run(s)\n", acc->win_first,
+              acc->win_end, (unsigned long long)acc->nr_runs);
+
+    return access_map(acc);
+}
+
+static void access_close(struct mem_access *acc)
+{
+    if (acc->runs) {
+        access_unmap(acc);
+        free(acc->runs);
+    }
+    acc->runs = NULL;
+    if (acc->fd >= 0)
+        close(acc->fd);
+    acc->fd = -1;
+}
+
+/*
+ * Open file and prepare the selected elements for access, by mapping the
+ * whole span, by mapping only the pages holding the elements, or by nothing
+ * at all for positional I/O. Return 0 on success, otherwise -1.
+ */
+static int access_open(struct mem_access *acc, const char *file, const int prot)
+{
+    const unsigned long long stride = (unsigned long long)acc->width * acc->step;
+
+    acc->file = file;
+    acc->prot = prot;
+    acc->page_size = sysconf(_SC_PAGESIZE);
+    acc->runs = NULL;
+    acc->nr_runs = 0;
+    acc->runs_max = 0;
+    acc->win_first = acc->win_end = 0;
+    acc->last_run = 0;
+
+    acc->fd = open(file, O_RDWR);
+    if (acc->fd < 0) {
+        fprintf(STDERR, "%s: open %s\n", strerror(errno), file);
+        return -1;
+    }
+
+    /* Never positional I/O, /dev/mem rejects it for MMIO. */
+    if (acc->strategy == ACCESS_AUTO) {
+        if (acc->number > 1 && stride >= SPARSE_STRIDE_PAGES_MIN * acc->page_size)
+            acc->strategy = ACCESS_SPARSE_MAP;
+        else
+            acc->strategy = ACCESS_FULL_MAP;
+    }
+
+    LOG_INFO("access strategy %d\n", acc->strategy);
+
+    switch (acc->strategy) {
+    case ACCESS_FULL_MAP:
+        acc->runs_max = 1;
+        break;
+    case ACCESS_SPARSE_MAP:
+        acc->runs_max = acc->number < SPARSE_MAP_RUNS_MAX ?
+                            acc->number : SPARSE_MAP_RUNS_MAX;
+        break;
+    default:
+        return 0;
+    }
+
+    acc->runs = calloc(acc->runs_max, sizeof(*acc->runs));
+    if (!acc->runs) {
+        fprintf(STDERR, "%s: calloc %llu runs\n", strerror(errno),
+                        (unsigned long long)acc->runs_max);
+        access_close(acc);
+        return -1;
+    }
+
+    if (acc->strategy == ACCESS_FULL_MAP) {
+        const unsigned long long last = elem_pos(acc, acc->number - 1) + acc->width;
+
+        acc->runs[0].first = 0;
+        acc->runs[0].pos = elem_pos(acc, 0) / acc->page_size * acc->page_size;
+        acc->runs[0].len = last - acc->runs[0].pos;
+        acc->nr_runs = 1;
+        acc->win_first = 0;
+        acc->win_end = acc->number;
+        if (access_map(acc)) {
+            access_close(acc);
+            return -1;
+        }
+    } else if (access_map_window(acc, 0)) {
+        access_close(acc);
+        return -1;
+    }
+
+    return 0;
+}
+
+static struct map_run *access_find_run(struct mem_access *acc,
+                                       const unsigned long long i)
+{
+    size_t lo = 0, hi, mid;
+
+    if (i < acc->win_first || i >= acc->win_end) {
+        if (access_map_window(acc, i))
+            return NULL;
+    }
+    hi = acc->nr_runs;
+
+    if (acc->runs[acc->last_run].first <= i) {
+        lo = acc->last_run;
+        if (lo + 1 == hi || acc->runs[lo + 1].first > i)
+            return &acc->runs[lo];
+    }
+
+    /* runs[lo].first <= i < runs[hi].first */
+    while (hi - lo > 1) {
+        mid = lo + (hi - lo) / 2;
+        if (acc->runs[mid].first <= i)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    acc->last_run = lo;
+
+    return &acc->runs[lo];
+}
+
+static inline void *access_va(struct mem_access *acc, const unsigned long long i)
+{
+    const struct map_run *run = access_find_run(acc, i);
+
+    if (!run)
+        return NULL;
+
+    return run->base + (elem_pos(acc, i) - run->pos);
+}
+
+static int access_read(struct mem_access *acc, const unsigned long long i,
+                       union elem_value *v)
+{
+    union multi_pointer va;
+    ssize_t rv;
+
+    if (acc->strategy == ACCESS_PIO) {
+        rv = pread(acc->fd, v, acc->width, elem_pos(acc, i));
+        if (rv < 0) {
+            LOG_ERR("%s: pread element %llu\n", strerror(errno), i);
+            return -1;
+        }
+        if (rv != acc->width) {
+            LOG_ERR("Short pread element %llu, %ld of %d bytes\n", i, (long)rv,
+                    acc->width);
+            return -1;
+        }
+        return 0;
+    }
+
+    va.p = access_va(acc, i);
+    if (!va.p)
+        return -1;
+    switch (acc->width) {
+    case WIDTH_BYTE:
+        v->u8 = *va.p8;
+        break;
+    case WIDTH_HALF:
+        v->u16 = *va.p16;
+        break;
+    case WIDTH_WORD:
+        v->u32 = *va.p32;
+        break;
+    case WIDTH_DWORD:
+        v->u64 = *va.p64;
+        break;
+    }
+
+    return 0;
+}
+
+static int access_write(struct mem_access *acc, const unsigned long long i,
+                        const union elem_value *v)
+{
+    union multi_pointer va;
+    ssize_t rv;
+
+    if (acc->strategy == ACCESS_PIO) {
+        rv = pwrite(acc->fd, v, acc->width, elem_pos(acc, i));
+        if (rv < 0) {
+            LOG_ERR("%s: pwrite element %llu\n", strerror(errno), i);
+            return -1;
+        }
+        if (rv != acc->width) {
+            LOG_ERR("Short pwrite element %llu, %ld of %d bytes\n", i, (long)rv,
+                    acc->width);
+            return -1;
+        }
+        return 0;
+    }
+
+    va.p = access_va(acc, i);
+    if (!va.p)
+        return -1;
+    switch (acc->width) {
+    case WIDTH_BYTE:
+        *va.p8 = v->u8;
+        break;
+    case WIDTH_HALF:
+        *va.p16 = v->u16;
+        break;
+    case WIDTH_WORD:
+        *va.p32 = v->u32;
+        break;
+    case WIDTH_DWORD:
+        *va.p64 = v->u64;
+        break;
+    }
+
+    return 0;
+}
+
 #define PRINT_COUNT_ONE_LINE_MAX        32
 #define PRINT_COUNT_ONE_LINE_DEFAULT    16
-static void dump_memb(const union multi_pointer va,
-                      const unsigned long number,
-                      const enum RDWR_WIDTH width,
-                      const size_t step,
-                      const size_t index,
-                      int print_cnt_one_line,
-                      const bool print_char,
-                      FILE *fp)
+static int dump_memb(struct mem_access *acc,
+                     int print_cnt_one_line,
+                     const bool print_char,
+                     FILE *fp)
 {
     unsigned long long i;
     int j, k;
     int idx;
     char p_tmp[256];
+    const unsigned long number = acc->number;
+    const enum RDWR_WIDTH width = acc->width;
+    const size_t step = acc->step;
     const unsigned long long size = number * (width * step);
     int valid_bit;
     int addr_width;
-    /* By width */
-    size_t base;
     /* By byte */
     unsigned long long offset;
-    /* By width */
-    size_t _index;
+    union elem_value v[PRINT_COUNT_ONE_LINE_MAX];
 
     /* Check */
-    if (!va.p) {
-        LOG_ERR("No va is provided\n");
-        return;
-    }
     if (!step) {
         LOG_ERR("step (%llu) too small, at least 1\n", (unsigned long long)step);
-        return;
+        return -1;
     }
 
     /* Assignment */
@@ -257,32 +656,32 @@ static void dump_memb(const union multi_pointer va,
     LOG_INFO("addr_width %d\n", addr_width);
 
     for (i = 0; i < number; i += print_cnt_one_line) {
-        base = i * step + index;
-        offset = base * width;
+        offset = (i * step + acc->index) * width;
         idx = 0;
 
         idx += snprintf(p_tmp + idx, sizeof(p_tmp) - idx, "%0*llx:", addr_width, offset);
 
-        for (j = 0, _index = base;
-             j < print_cnt_one_line && j + i < number;
-             j++, _index += step) {
+        for (j = 0; j < print_cnt_one_line && j + i < number; j++) {
+            if (access_read(acc, i + j, &v[j]))
+                return -1;
+
             switch(width) {
             case 1:
                 idx += snprintf(p_tmp + idx, sizeof(p_tmp) - idx,
-                                " %0*hhx", width * 2, va.p8[_index]);
+                                " %0*hhx", width * 2, v[j].u8);
                 break;
             case 2:
                 idx += snprintf(p_tmp + idx, sizeof(p_tmp) - idx,
-                                " %0*hx", width * 2, va.p16[_index]);
+                                " %0*hx", width * 2, v[j].u16);
                 break;
             case 4:
                 idx += snprintf(p_tmp + idx, sizeof(p_tmp) - idx,
-                                " %0*x", width * 2, va.p32[_index]);
+                                " %0*x", width * 2, v[j].u32);
                 break;
             case 8:
                 idx += snprintf(p_tmp + idx, sizeof(p_tmp) - idx,
                                 " %0*llx", width * 2,
-                                (unsigned long long)va.p64[_index]);
+                                (unsigned long long)v[j].u64);
                 break;
             }
         }
@@ -294,26 +693,192 @@ static void dump_memb(const union multi_pointer va,
 
             idx += snprintf(p_tmp + idx, sizeof(p_tmp) - idx, " | ");
 
-            for (j = 0;
-                 j < print_cnt_one_line && j + i < number;
-                 j++, offset += width * step) {
+            /* The bytes as read, no more access to the file. */
+            for (j = 0; j < print_cnt_one_line && j + i < number; j++) {
                 for (k = 0; k < (int)width; k++)
                     idx += snprintf(p_tmp + idx, sizeof(p_tmp) - idx, "%c",
-                                    isprint(*(uint8_t *)(va.p + k + offset)) ?
-                                        *(uint8_t *)(va.p + k + offset) : '.');
+                                    isprint(v[j].bytes[k]) ? v[j].bytes[k] : '.');
             }
         }
 
         fprintf(fp, "%s\n", p_tmp);
     }
+
+    return 0;
+}
+
+/* Large enough for several thousand records per fwrite(). */
+#define OUT_BUF_SIZE                    (64 * 1024)
+/* Longest record: JSONL with four 20-digit numbers. */
+#define OUT_RECORD_MAX                  128
+
+struct out_buf {
+    FILE *fp;
+    size_t len;
+    bool err;
+    char data[OUT_BUF_SIZE];
+};
+
+static void out_flush(struct out_buf *ob)
+{
+    if (ob->len && !ob->err && fwrite(ob->data, 1, ob->len, ob->fp) != ob->len) {
+        LOG_ERR("%s: fwrite %llu bytes\n", strerror(errno), (unsigned long long)ob->len);
+        ob->err = true;
+    }
+    ob->len = 0;
+}
+
+static inline void out_str(struct out_buf *ob, const char *s, const size_t n)
+{
+    memcpy(ob->data + ob->len, s, n);
+    ob->len += n;
+}
+
+#define OUT_LITERAL(ob, s)  out_str(ob, s, sizeof(s) - 1)
+
+static inline void out_dec(struct out_buf *ob, uint64_t v)
+{
+    char tmp[20];
+    int n = sizeof(tmp);
+
+    do {
+        tmp[--n] = '0' + v % 10;
+        v /= 10;
+    } while (v);
+
+    out_str(ob, tmp + n, sizeof(tmp) - n);
+}
+
+/* Zero padded to digits, as in dump_memb(). */
+static inline void out_hex(struct out_buf *ob, uint64_t v, const int digits)
+{
+    static const char hex[] = "0123456789abcdef";
+    char *p = ob->data + ob->len + digits;
+
+    ob->len += digits;
+    while (p > ob->data + ob->len - digits) {
+        *--p = hex[v & 0xf];
+        v >>= 4;
+    }
+}
+
+static inline void out_be64(struct out_buf *ob, const uint64_t v)
+{
+    const uint64_t t = htobe64(v);
+
+    out_str(ob, (const char *)&t, sizeof(t));
+}
+
+/*
+ * Dump elements as JSONL, CSV or BIN records, one per element. pass tells
+ * the reads apart in RD_WR_RD, the CSV header is only emitted for pass 1.
+ */
+static int dump_records(struct mem_access *acc,
+                        const enum DUMP_FORMAT format,
+                        const int pass,
+                        FILE *fp)
+{
+    static struct out_buf ob;
+    unsigned long long i;
+    union elem_value v;
+    uint64_t value = 0;
+    uint64_t pos;
+    bool read_err = false;
+
+    ob.fp = fp ? fp : (STDOUT ? STDOUT : stdout);
+    ob.len = 0;
+    ob.err = false;
+
+    if (format == FORMAT_CSV && pass == 1)
+        OUT_LITERAL(&ob, "offset,width,value,pass\n");
+
+    for (i = 0; i < acc->number && !ob.err; i++) {
+        /* Keep the records read so far, as dump_memb() does. */
+        if (access_read(acc, i, &v)) {
+            read_err = true;
+            break;
+        }
+
+        switch (acc->width) {
+        case WIDTH_BYTE:
+            value = v.u8;
+            break;
+        case WIDTH_HALF:
+            value = v.u16;
+            break;
+        case WIDTH_WORD:
+            value = v.u32;
+            break;
+        case WIDTH_DWORD:
+            value = v.u64;
+            break;
+        }
+        /* Relative to offset, as in dump_memb(). */
+        pos = (i * acc->step + acc->index) * acc->width;
+
+        if (ob.len + OUT_RECORD_MAX > sizeof(ob.data))
+            out_flush(&ob);
+
+        switch (format) {
+        case FORMAT_JSONL:
+            OUT_LITERAL(&ob, "{\"offset\":");
+            out_dec(&ob, pos);
+            OUT_LITERAL(&ob, ",\"width\":");
+            out_dec(&ob, acc->width);
+            /* A string, JSON numbers above 2^53 lose precision in doubles. */
+            OUT_LITERAL(&ob, ",\"value\":\"0x");
+            out_hex(&ob, value, acc->width * 2);
+            OUT_LITERAL(&ob, "\",\"pass\":");
+            out_dec(&ob, pass);
+            OUT_LITERAL(&ob, "}\n");
+            break;
+        case FORMAT_CSV:
+            out_dec(&ob, pos);
+            OUT_LITERAL(&ob, ",");
+            out_dec(&ob, acc->width);
+            OUT_LITERAL(&ob, ",");
+            out_dec(&ob, value);
+            OUT_LITERAL(&ob, ",");
+            out_dec(&ob, pass);
+            OUT_LITERAL(&ob, "\n");
+            break;
+        case FORMAT_BIN:
+            out_be64(&ob, pos);
+            out_be64(&ob, acc->width);
+            out_be64(&ob, value);
+            out_be64(&ob, pass);
+            break;
+        default:
+            break;
+        }
+    }
+    out_flush(&ob);
+    if (!ob.err && fflush(ob.fp)) {
+        LOG_ERR("%s: fflush\n", strerror(errno));
+        ob.err = true;
+    }
+
+    return ob.err || read_err ? -1 : 0;
+}
+
+static int dump(struct mem_access *acc,
+                const enum DUMP_FORMAT format,
+                int print_cnt_one_line,
+                const bool print_char,
+                const int pass,
+                FILE *fp)
+{
+    if (format == FORMAT_TEXT)
+        return dump_memb(acc, print_cnt_one_line, print_char, fp);
+
+    return dump_records(acc, format, pass, fp);
 }
 
 int main(int argc, char *argv[])
 {
     int ret = 0;
-    int fd;
     unsigned long long i;
-    union multi_pointer va = { .p = NULL, };
+    struct mem_access acc = { .fd = -1, };
     char *end;
     const char *file = "/dev/mem";
     int file_mode = F_OK;
@@ -327,6 +892,8 @@ int main(int argc, char *argv[])
     bool print_char = false;
     size_t index = 0;
     enum RDWR_MODE mode = MODE_RD_ONLY;
+    enum ACCESS_STRATEGY strategy = ACCESS_AUTO;
+    enum DUMP_FORMAT format = FORMAT_TEXT;
     size_t print_cnt_one_line = 0;  // Zero for auto.
     const char *bin_file = NULL;
     union multi_pointer buf = { .p = NULL, };
@@ -421,6 +988,34 @@ int main(int argc, char *argv[])
                 mode = t;
             }
             break;
+        case 'a':
+            {
+                unsigned long t = strtoul(optarg, &end, 0);
+                if (*end) {
+                    fprintf(stderr, "Invalid -a,--access \"%s\"\n", optarg);
+                    usage(argv[0], stderr, 126);
+                }
+                if (t >= ACCESS_NUM) {
+                    fprintf(stderr, "Invalid -a,--access %lu\n", t);
+                    usage(argv[0], stderr, 126);
+                }
+                strategy = t;
+            }
+            break;
+        case 'F':
+            {
+                unsigned long t = strtoul(optarg, &end, 0);
+                if (*end) {
+                    fprintf(stderr, "Invalid -F,--format \"%s\"\n", optarg);
+                    usage(argv[0], stderr, 126);
+                }
+                if (t >= FORMAT_NUM) {
+                    fprintf(stderr, "Invalid -F,--format %lu\n", t);
+                    usage(argv[0], stderr, 126);
+                }
+                format = t;
+            }
+            break;
         case 'P':
             print_cnt_one_line = strtoul(optarg, &end, 0);
             if (*end) {
@@ -473,6 +1068,9 @@ int main(int argc, char *argv[])
         STDERR = stderr;
     if (!STDOUT)
         STDOUT = stdout;
+    /* Keep logs out of machine readable output on stdout. */
+    if (format != FORMAT_TEXT)
+        STDOUT = stderr;
     if (level != LOG_LEVEL_UNKNOWN)
         log_level = level;
 
@@ -632,28 +1230,26 @@ int main(int argc, char *argv[])
     }
 
     /* mmap file */
-    fd = open(file, O_RDWR);
-    if (fd < 0) {
-        fprintf(STDERR, "%s: open %s\n", strerror(errno), file);
-        ret = 122;
-        goto free_buf;
-    }
-    va.p = mmap(NULL, size_min, PROT_READ | (mode == MODE_RD_ONLY ? 0 : PROT_WRITE),
-                MAP_SHARED, fd, offset);
-    if (va.p == MAP_FAILED) {
-        fprintf(STDERR, "%s: mmap %s offset 0x%llx, size 0x%llx\n", strerror(errno),
-                             file, offset, size_min);
-        close(fd);
+    acc.strategy = strategy;
+    acc.offset = offset;
+    acc.width = width;
+    acc.step = step;
+    acc.index = index;
+    acc.number = number;
+    if (access_open(&acc, file,
+                    PROT_READ | (mode == MODE_RD_ONLY ? 0 : PROT_WRITE))) {
         ret = 122;
         goto free_buf;
     }
-    close(fd);
 
     /* 1. read.1: RD_ONLY, RD_WR or RD_WR_RD */
     if (mode == MODE_RD_ONLY ||
         mode == MODE_RD_WR ||
         mode == MODE_RD_WR_RD) {
-        dump_memb(va, number, width, step, index, print_cnt_one_line, print_char, stdout);
+        if (dump(&acc, format, print_cnt_one_line, print_char, 1, stdout)) {
+            ret = 121;
+            goto close_acc;
+        }
     }
 
     /* 2. write: WR_ONLY, RD_WR, WR_RD or RD_WR_RD */
@@ -661,35 +1257,47 @@ int main(int argc, char *argv[])
         mode == MODE_RD_WR ||
         mode == MODE_WR_RD ||
         mode == MODE_RD_WR_RD) {
+        union elem_value v;
+
         for (i = 0; i < number; i++) {
             switch (width) {
             case WIDTH_BYTE:
-                va.p8[i * step + index] = buf.p8[i];
+                v.u8 = buf.p8[i];
                 break;
             case WIDTH_HALF:
-                va.p16[i * step + index] = buf.p16[i];
+                v.u16 = buf.p16[i];
                 break;
             case WIDTH_WORD:
-                va.p32[i * step + index] = buf.p32[i];
+                v.u32 = buf.p32[i];
                 break;
             case WIDTH_DWORD:
-                va.p64[i * step + index] = buf.p64[i];
+                v.u64 = buf.p64[i];
                 break;
             }
+            if (access_write(&acc, i, &v)) {
+                ret = 121;
+                goto close_acc;
+            }
         }
     }
 
     /* 3. read.2: WR_RD or RD_WR_RD */
     if (mode == MODE_WR_RD ||
         mode == MODE_RD_WR_RD) {
-        if (mode == MODE_RD_WR_RD)
+        /* Machine readable records carry the pass instead. */
+        if (mode == MODE_RD_WR_RD && format == FORMAT_TEXT)
             printf("---\n");
-        dump_memb(va, number, width, step, index, print_cnt_one_line, print_char, stdout);
+        if (dump(&acc, format, print_cnt_one_line, print_char,
+                 mode == MODE_RD_WR_RD ? 2 : 1, stdout)) {
+            ret = 121;
+            goto close_acc;
+        }
     }
 
     ret = 0;
 
-    if (!va.p && va.p != MAP_FAILED) munmap(va.p, size_min);
+close_acc:
+    access_close(&acc);
 free_buf:
     if (buf.p) free(buf.p);
     return ret;